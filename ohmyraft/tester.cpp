@@ -2,19 +2,217 @@
 #include <future>
 #include <thread>
 #include <chrono>
+#include <vector>
+#include <string>
+#include <filesystem>
+#include <unistd.h>
 
-#include "PromiseStore.H"
+#include "CompletionTable.H"
 #include "TestUtils.H"
 #include "ConsensusUtils.H"
 #include "TimeTravelSignal.H"
+#include "SegmentedLog.H"
+#include "MpscRing.H"
 // #include "OhMyRaft.H"
 
 using namespace raft;
 
+static int failures = 0;
+
+static void check( bool ok, const std::string& what )
+{
+  std::cout << ( ok ? "ok   " : "FAIL " ) << what << std::endl;
+  if ( ! ok ) {
+    failures++;
+  }
+}
+
+static LogEntry makeEntry( int32_t i )
+{
+  return {
+    .term = 1,
+    .op = {
+      .kind = RaftOp::PUT,
+      .args = RaftOp::putarg_t { Bytes( encodeOrdered( i ) ), Bytes( std::string( i % 100, 'v' ) ) }
+    }
+  };
+}
+
+static const Bytes& keyOf( const LogEntry& entry )
+{
+  return std::get<RaftOp::putarg_t>( entry.op.args ).first;
+}
+
+static std::string lastSegment( const std::string& dir )
+{
+  std::string last;
+  for ( auto& file: std::filesystem::directory_iterator( dir ) ) {
+    auto path = file.path().string();
+    if ( file.path().extension() == ".seg" && path > last ) {
+      last = path;
+    }
+  }
+  return last;
+}
+
+// A torn write at the end of the last segment is cut off on reopen, and so
+// is a record that doesn't pass its CRC. Everything before it is kept.
+static void checkSegmentTail()
+{
+  char dirTemplate[] = "/tmp/ohmyraft.tester.XXXXXX";
+  std::string dir = mkdtemp( dirTemplate );
+  auto base = dir + "/log";
+  const int32_t numEntries = 1000;
+  {
+    SegmentedLog<LogEntry> log;
+    log.setup( base, false );
+    for ( int32_t i = 0; i < numEntries; ++i ) {
+      log.push_back( makeEntry( i ) );
+    }
+    log.persist();
+  }
+
+  auto seg = lastSegment( dir );
+  auto segBytes = std::filesystem::file_size( seg );
+  {
+    // half a record past the end, as if we crashed while writing it
+    auto fd = open( seg.c_str(), O_WRONLY | O_APPEND );
+    std::string junk( 37, 'x' );
+    write( fd, junk.data(), junk.size() );
+    close( fd );
+  }
+  {
+    SegmentedLog<LogEntry> log;
+    log.setup( base, true );
+    check( log.size() == (size_t)numEntries, "torn tail is dropped on reopen" );
+    check( log.size() > 0 && keyOf( log.back() ) == keyOf( makeEntry( numEntries - 1 ) ),
+           "entries before a torn tail are intact" );
+  }
+  check( std::filesystem::file_size( seg ) == segBytes, "torn tail is cut off the segment" );
+
+  {
+    // flip a byte in the last record
+    auto fd = open( seg.c_str(), O_RDWR );
+    char byte;
+    pread( fd, &byte, 1, segBytes - 1 );
+    byte ^= 0xFF;
+    pwrite( fd, &byte, 1, segBytes - 1 );
+    close( fd );
+  }
+  {
+    SegmentedLog<LogEntry> log;
+    log.setup( base, true );
+    check( log.size() == (size_t)numEntries - 1, "record failing its CRC at the tail is dropped" );
+    log.push_back( makeEntry( numEntries - 1 ) );
+    log.persist();
+  }
+  {
+    SegmentedLog<LogEntry> log;
+    log.setup( base, true );
+    check( log.size() == (size_t)numEntries && keyOf( log.back() ) == keyOf( makeEntry( numEntries - 1 ) ),
+           "appending after a dropped tail works" );
+  }
+
+  std::filesystem::remove_all( dir );
+}
+
+// An entry that gets truncated is aborted once, and whatever later ends up
+// at its index, in a newer term, doesn't complete it again.
+static void checkAbortAfterTruncation()
+{
+  for ( size_t size: { 1 << 13, 1 } ) {
+    CompletionTable<int> table( size );
+    int calls = 0;
+    int got = 0;
+    std::function<void( int )> done = [&]( int val ) { calls++; got = val; };
+    table.insert( 5, 1, done );
+    // a second entry in the same slot, with a table of one it spills
+    int otherCalls = 0;
+    std::function<void( int )> other = [&]( int ) { otherCalls++; };
+    table.insert( 6, 1, other );
+
+    // the entry is truncated away, a new leader puts another at its index
+    table.complete( 5, 1, -1 );
+    table.complete( 5, 2, 42 );
+    table.complete( 5, 1, -1 );
+
+    auto tag = " (" + std::to_string( size ) + " slots)";
+    check( calls == 1 && got == -1, "truncated entry is aborted exactly once" + tag );
+    check( otherCalls == 0, "other entries are left alone" + tag );
+    table.complete( 6, 1, 0 );
+    check( otherCalls == 1, "other entries still complete" + tag );
+  }
+}
+
+// Several producers going round a small ring many times, every item has to
+// arrive once, and in order per producer.
+static void checkRingWraparound()
+{
+  const uint64_t numProducers = 4;
+  const uint64_t perProducer = 100000;
+  MpscRing<uint64_t> ring( 4 );
+  TimeTravelSignal ready;
+
+  std::vector<std::thread> producers;
+  for ( uint64_t p = 0; p < numProducers; ++p ) {
+    producers.emplace_back( [&, p] {
+      for ( uint64_t i = 0; i < perProducer; ++i ) {
+        auto item = ( p << 32 ) | i;
+        bool wake = false;
+        while ( ! ring.tryPush( item, wake ) ) {
+          ready.signal();
+          std::this_thread::yield();
+        }
+        if ( wake ) {
+          ready.signal();
+        }
+      }
+    });
+  }
+
+  std::vector<uint64_t> next( numProducers, 0 );
+  uint64_t received = 0;
+  uint64_t outOfOrder = 0;
+  uint64_t lostWakeups = 0;
+  while ( received < numProducers * perProducer ) {
+    // the timeout is only there so that a lost wake up fails the check
+    // rather than hanging it
+    auto signalled = ready.waitFor( std::chrono::milliseconds( 1000 ) );
+    auto drained = ring.drain( [&]( uint64_t&& item ) {
+      auto p = item >> 32;
+      if ( p >= numProducers || ( item & 0xFFFFFFFF ) != next[p]++ ) {
+        outOfOrder++;
+      }
+    }, ring.capacity() );
+    if ( ! signalled && drained > 0 ) {
+      lostWakeups++;
+    }
+    if ( drained == ring.capacity() ) {
+      ready.signal();
+    }
+    received += drained;
+  }
+  for ( auto& th: producers ) {
+    th.join();
+  }
+
+  check( received == numProducers * perProducer && outOfOrder == 0,
+         "ring hands over every item in order across wraparounds" );
+  check( lostWakeups == 0, "consumer is woken up for every item" );
+  bool wake = false;
+  check( ring.drain( []( uint64_t&& ) {}, ring.capacity() ) == 0, "ring is empty afterwards" );
+  uint64_t item = 7;
+  check( ring.tryPush( item, wake ) && wake, "first push into an empty ring wakes the consumer" );
+}
+
 int main()
 {
+  checkSegmentTail();
+  checkAbortAfterTruncation();
+  checkRingWraparound();
+
   std::cout << "hello world!" << std::endl;
-  
+
   raft::TimeTravelSignal sig;
 
   auto th = std::thread([&sig]{
@@ -39,5 +237,5 @@ int main()
 
   th2.join();
 
-
+  return failures > 0 ? 1 : 0;
 }
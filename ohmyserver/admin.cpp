@@ -4,6 +4,7 @@
 #include <unistd.h>
 #include <argparse/argparse.hpp>
 #include <chrono>
+#include <thread>
 #include <cstring>
 #include <map>
 
@@ -12,10 +13,13 @@
 #include "RaftService.H"
 #include "ConsensusUtils.H"
 
+// Membership changes go to every raft group, each of which has a leader
+// of its own. numGroups has to match what the replicas run with.
 class Admin {
 public:
-  Admin( std::map<int32_t, ServerInfo> servers ): servers_(servers),
-        client_( grpc::CreateChannel( "10.10.1.1:1234", grpc::InsecureChannelCredentials() ) ) {}
+  Admin( std::map<int32_t, ServerInfo> servers, int32_t numGroups = 1 ): servers_(servers),
+        client_( grpc::CreateChannel( "10.10.1.1:1234", grpc::InsecureChannelCredentials() ) ),
+        numGroups_( numGroups ) {}
 
   bool AddServer( int id, std::string ip, int db_port, int raft_port, std::string name );
   bool RemoveServer( int id );
@@ -25,6 +29,11 @@ private:
   static constexpr const int32_t MAX_TRIES = 1000;
   std::map<int32_t, ServerInfo> servers_; // map of server id to server info
   RaftClient client_;
+  int32_t numGroups_;
+  int32_t group_ = 0; // the group client_ talks to
+
+  bool AddServerToGroup( raft::AddServerParams param );
+  bool RemoveServerFromGroup( raft::RemoveServerParams param );
 
   void SwitchClient ( int server_id );
   void SwitchClient ( std::string addr );
@@ -35,13 +44,13 @@ void Admin::SwitchClient ( int server_id )
     ServerInfo info = servers_[server_id];
     std::string addr = std::string(info.ip) + ":" + std::to_string(info.raft_port);
     LogInfo ( "Switching to " + addr );
-    client_ = RaftClient ( grpc::CreateChannel( addr, grpc::InsecureChannelCredentials() ) );
+    client_ = RaftClient ( grpc::CreateChannel( addr, grpc::InsecureChannelCredentials() ), group_ );
 }
 
 void Admin::SwitchClient ( std::string addr )
 {
     LogInfo ( "Switching to " + addr );
-    client_ = RaftClient ( grpc::CreateChannel( addr, grpc::InsecureChannelCredentials() ) );
+    client_ = RaftClient ( grpc::CreateChannel( addr, grpc::InsecureChannelCredentials() ), group_ );
 }
 
 bool Admin::AddServer( int id, std::string ip, int db_port, int raft_port, std::string name ) 
@@ -63,6 +72,17 @@ bool Admin::AddServer( int id, std::string ip, int db_port, int raft_port, std::
     strcpy( param.ip, ip.c_str() );
     strcpy( param.name, name.c_str() );
 
+    for ( group_ = 0; group_ < numGroups_; ++group_ ) {
+        LogInfo( "Adding server " + std::to_string(id) + " to group " + std::to_string(group_) );
+        if ( ! AddServerToGroup( param ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Admin::AddServerToGroup( raft::AddServerParams param )
+{
     auto iters = MAX_TRIES;
     int server_id = 0;
     SwitchClient( server_id );
@@ -106,6 +126,15 @@ bool Admin::AddServer( int id, std::string ip, int db_port, int raft_port, std::
             case raft::ErrorCode::SERVER_NOT_FOUND: {
                 __builtin_unreachable();
             }
+            case raft::ErrorCode::NO_READ_INDEX: {
+                // only reads are answered with this
+                LogWarn( "Unexpected error. Retrying." );
+                break;
+            }
+            case raft::ErrorCode::BUSY: {
+                LogWarn( "The leader is busy. Retrying." );
+                break;
+            }
             case raft::ErrorCode::OTHER: {
                 LogWarn( "Unknown error. Retrying." );
                 break;
@@ -125,6 +154,17 @@ bool Admin::RemoveServer( int id )
         .serverId = id
     };
 
+    for ( group_ = 0; group_ < numGroups_; ++group_ ) {
+        LogInfo( "Removing server " + std::to_string(id) + " from group " + std::to_string(group_) );
+        if ( ! RemoveServerFromGroup( param ) ) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Admin::RemoveServerFromGroup( raft::RemoveServerParams param )
+{
     auto iters = MAX_TRIES;
     int server_id = 0;
     SwitchClient( server_id );
@@ -145,7 +185,7 @@ bool Admin::RemoveServer( int id )
         
         switch ( ret.value().errorCode ) {
             case raft::ErrorCode::OK: {
-                LogInfo( "Successfully removed server " + std::to_string(id) );
+                LogInfo( "Successfully removed server " + std::to_string(param.serverId) );
                 return true;
             }
             case raft::ErrorCode::NOT_LEADER: {
@@ -168,6 +208,15 @@ bool Admin::RemoveServer( int id )
             case raft::ErrorCode::SERVER_EXISTS: {
               __builtin_unreachable();
             }
+            case raft::ErrorCode::NO_READ_INDEX: {
+                // only reads are answered with this
+                LogWarn( "Unexpected error. Retrying." );
+                break;
+            }
+            case raft::ErrorCode::BUSY: {
+                LogWarn( "The leader is busy. Retrying." );
+                break;
+            }
             case raft::ErrorCode::OTHER: {
                 LogWarn( "Unknown error. Retrying." );
                 break;
@@ -230,6 +279,9 @@ int main(int argc, char **argv)
         .help("Name of the node. Only needed when addedNode is true.")
         .default_value("");
 
+    program.add_argument("--groups")
+        .help("Number of raft groups the replicas run, the change is made in each of them.")
+        .default_value("1");
 
     try {
         program.parse_args( argc, argv );
@@ -252,10 +304,11 @@ int main(int argc, char **argv)
     auto raft_port = std::stoi(program.get<std::string>("--raft_port"));
     auto db_port = std::stoi(program.get<std::string>("--db_port"));
     auto name = program.get<std::string>("--name");
+    auto numGroups = std::max(1, std::stoi(program.get<std::string>("--groups")));
 
     auto servers = ParseConfig(configPath);
 
-    auto admin = Admin( servers );
+    auto admin = Admin( servers, numGroups );
 
     if ( op == "add" ) {
         auto ret = admin.AddServer( id, ip, db_port, raft_port, name );
@@ -6,6 +6,8 @@
 #include <memory>
 #include <argparse/argparse.hpp>
 #include <chrono>
+#include <mutex>
+#include <condition_variable>
 
 #include "OhMyConfig.H"
 #include "DatabaseClient.H"
@@ -14,12 +16,28 @@
 #include "ReplicatedDB.H"
 #include <random>
 
-void writeTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t iter)
+std::string randomKey(size_t numPairs)
+{
+    return "key" + std::to_string(rand()%numPairs);
+}
+
+// printable, so that values are easy to eyeball in the logs
+std::string randomValue(size_t valueSize)
+{
+    std::string value(valueSize, '\0');
+    for(auto& c: value)
+    {
+        c = 'a' + rand()%26;
+    }
+    return value;
+}
+
+void writeTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t valueSize, size_t iter)
 {
     auto start = std::chrono::high_resolution_clock::now();
     for(size_t i = 0; i < iter; i++)
     {
-        repDB.put( std::make_pair( rand()%numPairs, rand()) );
+        repDB.put( std::make_pair( randomKey(numPairs), randomValue(valueSize) ) );
     }
     auto end = std::chrono::high_resolution_clock::now();
 
@@ -42,7 +60,7 @@ void readTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t iter)
     auto start = std::chrono::high_resolution_clock::now();
     for(size_t i = 0; i < iter; i++)
     {
-        repDB.get(rand()%numPairs);
+        repDB.get(randomKey(numPairs));
     }
     auto end = std::chrono::high_resolution_clock::now();
 
@@ -60,18 +78,18 @@ void readTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t iter)
 
 }
 
-void readWriteTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t iter)
+void readWriteTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t valueSize, size_t iter)
 {
     auto start = std::chrono::high_resolution_clock::now();
     for(size_t i = 0; i < iter; i++)
     {
         if(rand()%2)
         {
-            repDB.get(rand()%numPairs);
+            repDB.get(randomKey(numPairs));
         }
         else
         {
-            repDB.put( std::make_pair( rand()%numPairs, rand()) );
+            repDB.put( std::make_pair( randomKey(numPairs), randomValue(valueSize) ) );
         }
     }
     auto end = std::chrono::high_resolution_clock::now();
@@ -91,6 +109,130 @@ void readWriteTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t iter)
 
 }
 
+// same number of pairs as writeTest, batchSize of them per request
+void batchedWriteTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t valueSize,
+                      size_t batchSize, size_t iter)
+{
+    auto start = std::chrono::high_resolution_clock::now();
+    std::vector<std::pair<std::string, std::string>> batch;
+    for(size_t i = 0; i < iter; i++)
+    {
+        batch.emplace_back( randomKey(numPairs), randomValue(valueSize) );
+        if(batch.size() == batchSize || i + 1 == iter)
+        {
+            repDB.multiPut(batch);
+            batch.clear();
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    double seconds = duration / 1000.0;
+
+    double avgLatency = duration / (double)iter;
+
+    std::cout << "========================\n";
+    std::cout << "Batched Write Test Results:\n";
+    std::cout << "Operations: " << iter << " in batches of " << batchSize << "\n";
+    std::cout << "Elapsed Time: " << seconds << " s\n";
+    std::cout << "Average Latency per Pair: " << avgLatency << " ms\n";
+
+}
+
+// same number of pairs as writeTest, with up to inflight puts outstanding
+void pipelinedWriteTest(ohmydb::ReplicatedDB &repDB, size_t numPairs, size_t valueSize,
+                        size_t inflight, size_t iter)
+{
+    std::mutex mut;
+    std::condition_variable cv;
+    size_t outstanding = 0;
+    size_t failed = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    for(size_t i = 0; i < iter; i++)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mut);
+            cv.wait(lock, [&] { return outstanding < inflight; });
+            outstanding++;
+        }
+        repDB.putAsync( std::make_pair( randomKey(numPairs), randomValue(valueSize) ),
+            [&](bool ok) {
+                std::lock_guard<std::mutex> lock(mut);
+                outstanding--;
+                failed += !ok;
+                cv.notify_one();
+            });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mut);
+        cv.wait(lock, [&] { return outstanding == 0; });
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    double seconds = duration / 1000.0;
+
+    std::cout << "========================\n";
+    std::cout << "Pipelined Write Test Results:\n";
+    std::cout << "Operations: " << iter << " with up to " << inflight << " in flight\n";
+    std::cout << "Failed: " << failed << "\n";
+    std::cout << "Elapsed Time: " << seconds << " s\n";
+    std::cout << "Throughput: " << (seconds > 0 ? iter / seconds : 0) << " ops/s\n";
+
+}
+
+// every add bumps the same counter, checks none of them got lost
+void counterTest(ohmydb::ReplicatedDB &repDB, size_t iter)
+{
+    std::string counter = "counter" + std::to_string(rand());
+    auto start = std::chrono::high_resolution_clock::now();
+    std::optional<int64_t> value;
+    for(size_t i = 0; i < iter; i++)
+    {
+        value = repDB.add(counter, 1);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    double avgLatency = duration / (double)iter;
+
+    std::cout << "========================\n";
+    std::cout << "Counter Test Results:\n";
+    std::cout << "Operations: " << iter << "\n";
+    std::cout << "Final Value: " << value.value_or(-1) << "\n";
+    std::cout << "Elapsed Time: " << duration / 1000.0 << " s\n";
+    std::cout << "Average Latency: " << avgLatency << " ms\n";
+
+    // a lock is a key that is there while it is held
+    auto lock = repDB.compareAndSwap(counter + ".lock", std::nullopt, "held");
+    auto again = repDB.compareAndSwap(counter + ".lock", std::nullopt, "held");
+    if ( value != (int64_t)iter || ! lock.has_value() || ! lock->swapped ||
+         ! again.has_value() || again->swapped ) {
+        std::cout << "Counter Test FAILED\n";
+    }
+
+}
+
+void scanTest(ohmydb::ReplicatedDB &repDB)
+{
+    size_t numPairs = 0;
+    auto start = std::chrono::high_resolution_clock::now();
+    repDB.scan("", "", 0, [&](const std::string&, const std::string&) { numPairs++; });
+    auto end = std::chrono::high_resolution_clock::now();
+
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+
+    std::cout << "========================\n";
+    std::cout << "Scan Test Results:\n";
+    std::cout << "Pairs: " << numPairs << "\n";
+    std::cout << "Elapsed Time: " << duration / 1000.0 << " s\n";
+
+}
+
 int main(int argc, char **argv)
 {
     argparse::ArgumentParser program("client");
@@ -106,6 +248,43 @@ int main(int argc, char **argv)
         .default_value("10")
         .help("Number of possible keys for testing.");
 
+    program.add_argument("--valuesize")
+        .default_value("8")
+        .help("Size of the values written, in bytes.");
+
+    program.add_argument("--batchsize")
+        .default_value("16")
+        .help("Pairs per MultiPut in the batched write test, 0 to skip it.");
+
+    program.add_argument("--inflight")
+        .default_value("64")
+        .help("Puts in flight at once in the pipelined write test, 0 to skip it.");
+
+    program.add_argument("--coalesce_us")
+        .default_value("0")
+        .help("Send puts that come in within this many us as one MultiPut, 0 to not.");
+
+    program.add_argument("--coalesce_pairs")
+        .default_value("64")
+        .help("Most pairs sent together when coalescing puts.");
+
+    program.add_argument("--followerreads")
+        .help("let followers serve reads within the staleness bounds below")
+        .default_value( false )
+        .implicit_value( true );
+
+    program.add_argument("--stale_entries")
+        .default_value("0")
+        .help("Max entries a follower read may lag behind the leader's commit index.");
+
+    program.add_argument("--stale_ms")
+        .default_value("1000")
+        .help("Max ms since the follower heard from the leader, -1 for no bound.");
+
+    program.add_argument("--groups")
+        .default_value("1")
+        .help("Number of raft groups the replicas run, see replica --groups.");
+
     //program.add_argument("--id")
     //    .default_value("0")
     //    .help("Initial node to contact.");
@@ -125,13 +304,37 @@ int main(int argc, char **argv)
     auto configPath = program.get<std::string>("--config");
     auto iter = std::stoi(program.get<std::string>("--iter"));
     auto numPairs = std::stoi(program.get<std::string>("--numkeys"));
+    auto valueSize = std::stoi(program.get<std::string>("--valuesize"));
+    auto batchSize = std::stoi(program.get<std::string>("--batchsize"));
+    auto inflight = std::stoi(program.get<std::string>("--inflight"));
+    auto coalesceUs = std::stoi(program.get<std::string>("--coalesce_us"));
+    auto coalescePairs = std::stoi(program.get<std::string>("--coalesce_pairs"));
+    auto followerReads = program["--followerreads"] == true;
+    auto staleEntries = std::stoi(program.get<std::string>("--stale_entries"));
+    auto staleMs = std::stoi(program.get<std::string>("--stale_ms"));
+    auto numGroups = std::stoi(program.get<std::string>("--groups"));
 
     auto servers = ParseConfig(configPath);
 
-    auto repDB = ohmydb::ReplicatedDB(servers);
-    writeTest(repDB, numPairs, 1lu<<iter);
+    auto repDB = ohmydb::ReplicatedDB(servers, std::max(1, numGroups));
+    if ( followerReads ) {
+        repDB.setFollowerReads( ohmydb::StaleReadBounds { staleEntries, staleMs } );
+    }
+    if ( coalesceUs > 0 ) {
+        repDB.setWriteCoalescing( ohmydb::WriteCoalescing {
+            std::chrono::microseconds( coalesceUs ), (size_t)std::max( 1, coalescePairs ) } );
+    }
+    writeTest(repDB, numPairs, valueSize, 1lu<<iter);
     readTest(repDB, numPairs, 1lu<<iter);
-    readWriteTest(repDB, numPairs, 1lu<<iter);
+    readWriteTest(repDB, numPairs, valueSize, 1lu<<iter);
+    if ( batchSize > 0 ) {
+        batchedWriteTest(repDB, numPairs, valueSize, batchSize, 1lu<<iter);
+    }
+    if ( inflight > 0 ) {
+        pipelinedWriteTest(repDB, numPairs, valueSize, inflight, 1lu<<iter);
+    }
+    counterTest(repDB, 1lu<<iter);
+    scanTest(repDB);
 
     // for test only
     //auto printOpt = []( auto&& tag, auto&& opt ) {
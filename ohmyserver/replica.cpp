@@ -86,6 +86,35 @@ int main(int argc, char **argv)
       .help("DB port of the node. Only needed when addedNode is true.")
       .default_value("-1");
     
+  program.add_argument("--db_cache_mb")
+      .help("size of the leveldb block cache in MB")
+      .default_value("64");
+
+  program.add_argument("--db_write_buffer_mb")
+      .help("size of the leveldb write buffer (memtable) in MB")
+      .default_value("16");
+
+  program.add_argument("--db_bloom_bits")
+      .help("bits per key of the leveldb bloom filter, 0 to disable it")
+      .default_value("10");
+
+  program.add_argument("--db_no_compression")
+      .help("disable snappy compression of leveldb blocks")
+      .default_value( false )
+      .implicit_value( true );
+
+  program.add_argument("--engine")
+      .help("storage engine, leveldb or memory. memory keeps nothing on disk and is rebuilt from raft snapshots on restart")
+      .default_value("leveldb");
+
+  program.add_argument("--read_cache_mb")
+      .help("size of the read cache in front of leveldb in MB, 0 to disable it")
+      .default_value("32");
+
+  program.add_argument("--groups")
+      .help("number of raft groups the keys are split across, must be the same on every replica and client")
+      .default_value("1");
+
   program.add_argument("--quicktest")
       .help("generates two ops after startup for a quick test")
       .default_value( false )
@@ -111,6 +140,21 @@ int main(int argc, char **argv)
   auto raft_port = std::stoi(program.get<std::string>("--raft_port"));
   auto db_port = std::stoi(program.get<std::string>("--db_port"));
   auto enableQuickTest = program["--quicktest"] == true;
+  auto numGroups = std::max(1, std::stoi(program.get<std::string>("--groups")));
+
+  auto engine = raft::parseStorageEngineKind(program.get<std::string>("--engine"));
+  if ( ! engine.has_value() ) {
+    std::cerr << "Unknown storage engine " << program.get<std::string>("--engine") << std::endl;
+    std::exit(1);
+  }
+
+  raft::StorageOptions dbOptions;
+  dbOptions.engine = engine.value();
+  dbOptions.blockCacheBytes = std::stoul(program.get<std::string>("--db_cache_mb")) << 20;
+  dbOptions.writeBufferBytes = std::stoul(program.get<std::string>("--db_write_buffer_mb")) << 20;
+  dbOptions.bloomBitsPerKey = std::stoi(program.get<std::string>("--db_bloom_bits"));
+  dbOptions.compression = program["--db_no_compression"] == false;
+  dbOptions.readCacheBytes = std::stoul(program.get<std::string>("--read_cache_mb")) << 20;
 
   auto servers = ParseConfig(config_path);
 
@@ -126,11 +170,12 @@ int main(int argc, char **argv)
   if ( ! isAddedNode ) {
     printServer("ServerDetails", id);
     ReplicaManager::Instance().initialiseServices(
-        servers, id, true, db_path, enableBootstrap, store_dir);
+        servers, id, true, db_path, enableBootstrap, store_dir,
+        "", -1, -1, dbOptions, numGroups);
   } else {
     ReplicaManager::Instance().initialiseServices(
       servers, id, false, db_path, enableBootstrap, store_dir,
-      ip, raft_port, db_port );  
+      ip, raft_port, db_port, dbOptions, numGroups );
   }
   
   // start up the replica
@@ -140,10 +185,16 @@ int main(int argc, char **argv)
 
   // -- @FIXME: remove once done, for test only
   if ( enableQuickTest ) {
-    ReplicaManager::Instance().put( std::make_pair(1, 2) );
-    LogInfo( "Received Output: " + std::to_string( ReplicaManager::Instance().get(1).value ) );
+    ReplicaManager::Instance().put( std::make_pair( raft::Bytes("1"), raft::Bytes("2") ) );
+    LogInfo( "Received Output: " + ReplicaManager::Instance().get( raft::Bytes("1") ).value );
   }
   // -- 
 
-  while( 1 ) { std::this_thread::sleep_for(std::chrono::seconds(5)); }
+  // runs until it is killed, report how the read cache is doing meanwhile
+  while( 1 ) {
+    std::this_thread::sleep_for(std::chrono::seconds(60));
+    for ( size_t group = 0; group < raft::Storage::numGroups(); ++group ) {
+      LogInfo( "Group=" + std::to_string(group) + " " + raft::Storage::Instance(group).cacheStats().str() );
+    }
+  }
 }
@@ -0,0 +1,137 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <random>
+
+#include <argparse/argparse.hpp>
+
+#include "WowLogger.H"
+#include "Bytes.H"
+#include "Storage.H"
+#include "BenchUtils.H"
+
+using namespace raft;
+
+// Runs the same workload against a storage engine directly, without raft
+// or grpc in the way, so that engines can be compared with each other.
+
+int main( int argc, char** argv ) {
+  argparse::ArgumentParser program( "enginebench" );
+
+  program.add_argument( "--engine" )
+    .default_value("leveldb")
+    .help("engine to benchmark, leveldb or memory");
+
+  program.add_argument( "--db_path" )
+    .default_value("/tmp/enginebench")
+    .help("where leveldb keeps its files, should not exist");
+
+  program.add_argument( "--numkeys" )
+    .default_value("100000")
+    .help("number of distinct keys");
+
+  program.add_argument( "--valuesize" )
+    .default_value("100")
+    .help("size of the values written, in bytes");
+
+  program.add_argument( "--batchsize" )
+    .default_value("64")
+    .help("pairs per putBatch, the way the executer applies committed PUTs");
+
+  program.add_argument( "--reads" )
+    .default_value("1000000")
+    .help("number of gets, split across the reader threads");
+
+  program.add_argument( "--threads" )
+    .default_value("4")
+    .help("reader threads");
+
+  try {
+      program.parse_args( argc, argv );
+  }
+  catch (const std::runtime_error& err) {
+      std::cerr << err.what() << std::endl;
+      std::cerr << program;
+      std::exit(1);
+  }
+
+  auto engine = parseStorageEngineKind( program.get<std::string>( "--engine" ) );
+  if ( ! engine.has_value() ) {
+    std::cerr << "Unknown storage engine " << program.get<std::string>( "--engine" ) << std::endl;
+    std::exit(1);
+  }
+  auto numKeys = std::stoul( program.get<std::string>( "--numkeys" ) );
+  auto valueSize = std::stoul( program.get<std::string>( "--valuesize" ) );
+  auto batchSize = std::max<size_t>( 1, std::stoul( program.get<std::string>( "--batchsize" ) ) );
+  auto numReads = std::stoul( program.get<std::string>( "--reads" ) );
+  auto numThreads = std::max<size_t>( 1, std::stoul( program.get<std::string>( "--threads" ) ) );
+
+  StorageOptions options;
+  options.engine = engine.value();
+  Storage::select( options.engine );
+  auto& db = Storage::Instance();
+  db.initialize( program.get<std::string>( "--db_path" ), options );
+
+  std::vector<Bytes> keys;
+  for ( size_t i = 0; i < numKeys; ++i ) {
+    keys.emplace_back( encodeOrdered( (int64_t)i ) );
+  }
+  Bytes value( std::string( valueSize, 'v' ) );
+
+  auto writeMs = timeMs( [&] {
+    std::vector<std::pair<Bytes, Bytes>> batch;
+    for ( size_t i = 0; i < numKeys; ++i ) {
+      batch.emplace_back( keys[i], value );
+      if ( batch.size() == batchSize || i + 1 == numKeys ) {
+        db.putBatch( batch );
+        batch.clear();
+      }
+    }
+  });
+  report( "putBatch", numKeys, writeMs );
+
+  size_t found = 0;
+  auto readMs = timeMs( [&] {
+    std::vector<std::thread> readers;
+    std::vector<size_t> foundBy( numThreads, 0 );
+    for ( size_t t = 0; t < numThreads; ++t ) {
+      readers.emplace_back( [&, t] {
+        std::mt19937_64 rng( t );
+        for ( size_t i = 0; i < numReads / numThreads; ++i ) {
+          foundBy[t] += db.get( keys[rng() % numKeys] ).has_value();
+        }
+      });
+    }
+    for ( auto& reader: readers ) {
+      reader.join();
+    }
+    for ( auto n: foundBy ) {
+      found += n;
+    }
+  });
+  report( "get x" + std::to_string( numThreads ), numReads / numThreads * numThreads, readMs );
+
+  size_t scanned = 0;
+  auto scanMs = timeMs( [&] {
+    db.scan( Bytes(), Bytes(), 0, [&]( const Bytes&, const Bytes& ) { ++scanned; return true; } );
+  });
+  report( "scan", scanned, scanMs );
+
+  size_t visited = 0;
+  auto snapMs = timeMs( [&] {
+    auto snap = db.takeSnapshot();
+    db.forEach( snap, [&]( const Bytes&, const Bytes& ) { ++visited; } );
+    db.releaseSnapshot( snap );
+  });
+  report( "snapshot", visited, snapMs );
+
+  if ( found != numReads / numThreads * numThreads || scanned != numKeys || visited != numKeys ) {
+    LogError("Engine lost keys, found=" + std::to_string( found ) +
+             " scanned=" + std::to_string( scanned ) +
+             " visited=" + std::to_string( visited ));
+    return 1;
+  }
+  return 0;
+}
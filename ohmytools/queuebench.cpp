@@ -0,0 +1,203 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <atomic>
+
+#include <argparse/argparse.hpp>
+
+#include "WowLogger.H"
+#include "Bytes.H"
+#include "ConsensusUtils.H"
+#include "TimeTravelSignal.H"
+#include "MpscRing.H"
+#include "BenchUtils.H"
+
+using namespace raft;
+
+// Measures what it costs to hand log entries from a few threads to one,
+// the way submitted jobs go to the raft thread and committed entries to
+// the executer. The list is how RaftManager used to do it, a std::list
+// swapped out under a mutex, the ring is MpscRing.
+
+LogEntry makeEntry( size_t producer, size_t seq, const Bytes& value )
+{
+  return {
+    .term = (int)producer,
+    .op = {
+      .kind = RaftOp::PUT,
+      .args = RaftOp::putarg_t { Bytes( encodeOrdered( (int64_t)seq ) ), value }
+    }
+  };
+}
+
+// Checks each producer's entries arrive in the order they were pushed,
+// term is the producer and the key its sequence number.
+class OrderCheck {
+public:
+  explicit OrderCheck( size_t producers ) : next_( producers, 0 ) {}
+  void see( const LogEntry& entry ) {
+    auto& key = std::get<RaftOp::putarg_t>( entry.op.args ).first;
+    if ( key != Bytes( encodeOrdered( (int64_t)next_[entry.term]++ ) ) ) {
+      ++outOfOrder_;
+    }
+  }
+  size_t outOfOrder() const { return outOfOrder_; }
+private:
+  std::vector<size_t> next_;
+  size_t outOfOrder_ = 0;
+};
+
+size_t runList( size_t producers, size_t perProducer, const Bytes& value, OrderCheck& check )
+{
+  std::mutex mut;
+  std::list<LogEntry> out, in;
+  TimeTravelSignal ready;
+
+  std::vector<std::thread> threads;
+  for ( size_t p = 0; p < producers; ++p ) {
+    threads.emplace_back( [&, p] {
+      for ( size_t i = 0; i < perProducer; ++i ) {
+        auto entry = makeEntry( p, i, value );
+        std::lock_guard<std::mutex> lock( mut );
+        out.push_back( std::move( entry ) );
+        ready.signal();
+      }
+    });
+  }
+
+  size_t received = 0;
+  while ( received < producers * perProducer ) {
+    ready.wait();
+    mut.lock();
+    std::swap( out, in );
+    mut.unlock();
+    for ( auto& entry: in ) {
+      check.see( entry );
+    }
+    received += in.size();
+    in.clear();
+  }
+  for ( auto& th: threads ) {
+    th.join();
+  }
+  return received;
+}
+
+size_t runRing( size_t producers, size_t perProducer, size_t capacity,
+                const Bytes& value, OrderCheck& check )
+{
+  MpscRing<LogEntry> ring( capacity );
+  TimeTravelSignal ready;
+  std::atomic<size_t> stalls = 0;
+
+  std::vector<std::thread> threads;
+  for ( size_t p = 0; p < producers; ++p ) {
+    threads.emplace_back( [&, p] {
+      for ( size_t i = 0; i < perProducer; ++i ) {
+        auto entry = makeEntry( p, i, value );
+        bool wake = false;
+        while ( ! ring.tryPush( entry, wake ) ) {
+          ready.signal();
+          stalls++;
+          std::this_thread::yield();
+        }
+        if ( wake ) {
+          ready.signal();
+        }
+      }
+    });
+  }
+
+  std::vector<LogEntry> in;
+  size_t received = 0;
+  while ( received < producers * perProducer ) {
+    ready.wait();
+    auto drained = ring.drain( [&]( LogEntry&& entry ) {
+      in.push_back( std::move( entry ) );
+    }, ring.capacity() );
+    if ( drained == ring.capacity() ) {
+      ready.signal();
+    }
+    for ( auto& entry: in ) {
+      check.see( entry );
+    }
+    received += in.size();
+    in.clear();
+  }
+  for ( auto& th: threads ) {
+    th.join();
+  }
+  LogInfo("Producers found the ring full " + std::to_string( stalls ) + " times");
+  return received;
+}
+
+int main( int argc, char** argv ) {
+  argparse::ArgumentParser program( "queuebench" );
+
+  program.add_argument( "--ops" )
+    .default_value("1000000")
+    .help("number of entries handed over, split across the producers");
+
+  program.add_argument( "--producers" )
+    .default_value("4")
+    .help("producer threads, e.g. clients submitting jobs");
+
+  program.add_argument( "--capacity" )
+    .default_value("4096")
+    .help("slots in the ring");
+
+  program.add_argument( "--valuesize" )
+    .default_value("100")
+    .help("size of the values in the entries, in bytes");
+
+  try {
+      program.parse_args( argc, argv );
+  }
+  catch (const std::runtime_error& err) {
+      std::cerr << err.what() << std::endl;
+      std::cerr << program;
+      std::exit(1);
+  }
+
+  auto numProducers = std::max<size_t>( 1, std::stoul( program.get<std::string>( "--producers" ) ) );
+  auto perProducer = std::stoul( program.get<std::string>( "--ops" ) ) / numProducers;
+  auto capacity = std::max<size_t>( 1, std::stoul( program.get<std::string>( "--capacity" ) ) );
+  Bytes value( std::string( std::stoul( program.get<std::string>( "--valuesize" ) ), 'v' ) );
+  auto numOps = perProducer * numProducers;
+
+  // the entries are made on the producer threads in both runs, so this is
+  // only here to tell how much of the time goes to making them
+  auto makeMs = timeMs( [&] {
+    for ( size_t i = 0; i < numOps; ++i ) {
+      auto entry = makeEntry( 0, i, value );
+    }
+  });
+  report( "make", numOps, makeMs );
+
+  OrderCheck listCheck( numProducers );
+  size_t listReceived = 0;
+  auto listMs = timeMs( [&] {
+    listReceived = runList( numProducers, perProducer, value, listCheck );
+  });
+  report( "list x" + std::to_string( numProducers ), numOps, listMs );
+
+  OrderCheck ringCheck( numProducers );
+  size_t ringReceived = 0;
+  auto ringMs = timeMs( [&] {
+    ringReceived = runRing( numProducers, perProducer, capacity, value, ringCheck );
+  });
+  report( "ring x" + std::to_string( numProducers ), numOps, ringMs );
+
+  if ( listReceived != numOps || ringReceived != numOps ||
+       listCheck.outOfOrder() || ringCheck.outOfOrder() ) {
+    LogError("Entries got lost or reordered, list=" + std::to_string( listReceived ) +
+             " ring=" + std::to_string( ringReceived ) +
+             " out of " + std::to_string( numOps ));
+    return 1;
+  }
+  return 0;
+}
@@ -6,6 +6,7 @@
 #include "ConsensusUtils.H"
 #include "PersistentStore.H"
 #include "PersistentVector.H"
+#include "SegmentedLog.H"
 
 using namespace raft;
 
@@ -20,6 +21,10 @@ int main( int argc, char** argv) {
     .default_value( false )
     .implicit_value( true );
 
+  program.add_argument("--log")
+    .help("the provided file is the base name of a segmented log, e.g. raft.1.log")
+    .default_value( false )
+    .implicit_value( true );
 
   try {
       program.parse_args( argc, argv );
@@ -32,17 +37,27 @@ int main( int argc, char** argv) {
   
   auto filename = program.get<std::string>( "--file" );
   auto isVec = program["--vec"] == true;
+  auto isLog = program["--log"] == true;
 
   LogInfo("Reading File=" + filename + " "
-          + " IsPersistentVector=" + std::to_string(isVec) );
+          + " IsPersistentVector=" + std::to_string(isVec)
+          + " IsSegmentedLog=" + std::to_string(isLog) );
 
   if ( isVec ) {
-    PersistentVector<LogEntry> pVec;
+    // only logs from before the segmented log are in this format
+    PersistentVector<LegacyLogEntry> pVec;
     pVec.setup( filename, true );
-    auto cntr = 0;
+    auto cntr = pVec.startIndex();
     for ( const auto& entry: pVec ) {
       std::cout << "[" << cntr++ << "]\t" <<  
-        entry.str() << std::endl;
+        LogEntry::fromLegacy( entry ).str() << std::endl;
+    }
+  } else if ( isLog ) {
+    SegmentedLog<LogEntry> log;
+    log.setup( filename, true );
+    for ( auto i = log.startIndex(); i < log.size(); ++i ) {
+      std::cout << "[" << i << "]\t" <<
+        log[i].str() << std::endl;
     }
   } else {
     auto valOpt = PersistentStore::loadInt( filename );
@@ -7,7 +7,7 @@
 #include "ConsensusUtils.H"
 #include "OhMyConfig.H"
 #include "PersistentStore.H"
-#include "PersistentVector.H"
+#include "SegmentedLog.H"
 
 using namespace raft;
 
@@ -63,11 +63,10 @@ int main( int argc, char** argv ) {
   }
 
   auto storePrefix = outputDir + "raft." + std::to_string(id) + ".";
-  auto logFilename = storePrefix + "log.persist";
+  auto logFilename = storePrefix + "log";
 
-  PersistentVector<LogEntry> pVec;
-  pVec.setup( logFilename, false,
-     []( auto&& e ) { e.op = e.op.withoutPromise(); return e; } );
+  SegmentedLog<LogEntry> pVec;
+  pVec.setup( logFilename, false );
 
   for ( auto row: parsedInp.tokensByRow ) {
     auto term = std::stoi(row[parsedInp.header["term"]]);
@@ -79,9 +78,9 @@ int main( int argc, char** argv ) {
         .op = RaftOp {
           .kind = kind,
           .args = kind == RaftOp::GET
-                ? RaftOp::arg_t( rand()%100 )
-                : RaftOp::arg_t( std::make_pair( rand()%100, rand()%100 ) ),
-          .promiseHandle = {}
+                ? RaftOp::arg_t( Bytes( "key" + std::to_string( rand()%100 ) ) )
+                : RaftOp::arg_t( std::make_pair( Bytes( "key" + std::to_string( rand()%100 ) ),
+                                                 Bytes( std::to_string( rand()%100 ) ) ) )
         }
       });
     }
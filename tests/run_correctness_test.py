@@ -17,7 +17,7 @@ CURR_TERM = 'currentTerm'
 
 WRITESTORE = '{0}/writestore --id {1} --outputdir {2} --input {3}/rep{1}.csv --currentterm {4} --votedfor {5}'
 LAUNCH = '{0}/replica --id {1} --config {2} --db_path {3}/db{1} --storedir {3}'
-READSTORE = '{0}/readstore --vec --file {1}/raft.{2}.log.persist'
+READSTORE = '{0}/readstore --log --file {1}/raft.{2}.log'
 
 
 def main():